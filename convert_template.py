@@ -1,6 +1,16 @@
 #!/usr/bin/env python3
+# Gera template.h a partir de template.html (executado pelo CMake a cada build).
+#
+# Placeholders no HTML seguem o formato {{NOME:MAX}}, onde MAX é o tamanho
+# máximo em bytes (UTF-8) do texto inserido. Cada um vira um %s no template e
+# uma macro HTML_<NOME>_MAX; o tamanho fixo do HTML é exportado em
+# HTML_TEMPLATE_STATIC_LEN, permitindo dimensionar os buffers em tempo de
+# compilação.
+import re
 import sys
 
+PLACEHOLDER = re.compile(r'\{\{([A-Z][A-Z0-9_]*):([0-9]+)\}\}')
+
 if len(sys.argv) != 3:
     print("Usage: {} input.html output.h".format(sys.argv[0]))
     sys.exit(1)
@@ -11,13 +21,52 @@ output_file = sys.argv[2]
 with open(input_file, 'r', encoding='utf-8') as f:
     data = f.read()
 
+# Separa o texto fixo dos placeholders
+pieces = []
+placeholders = []
+pos = 0
+for match in PLACEHOLDER.finditer(data):
+    pieces.append(data[pos:match.start()])
+    name, max_len = match.group(1), int(match.group(2))
+    if name in (n for n, _ in placeholders):
+        sys.exit("{}: placeholder {} repetido".format(input_file, name))
+    placeholders.append((name, max_len))
+    pos = match.end()
+pieces.append(data[pos:])
+
+for piece in pieces:
+    if '{{' in piece or '}}' in piece:
+        sys.exit("{}: placeholder malformado (use {{{{NOME:MAX}}}})".format(input_file))
+
+static_len = sum(len(piece.encode('utf-8')) for piece in pieces)
+
+# Texto fixo vira string de formato: '%' literal precisa ser escapado
+fmt = '%s'.join(piece.replace('%', '%%') for piece in pieces)
+percent_count = sum(piece.count('%') for piece in pieces)
+
 # Escapa as barras invertidas e aspas, e converte as quebras de linha
-data = data.replace('\\', '\\\\')
-data = data.replace('"', '\\"')
-data = data.replace('\n', '\\n"\n"')
+fmt = fmt.replace('\\', '\\\\')
+fmt = fmt.replace('"', '\\"')
+fmt = fmt.replace('\n', '\\n"\n"')
 
-output = '#ifndef TEMPLATE_H\n#define TEMPLATE_H\n\n'
-output += 'const char html_template[] = \"' + data + '";\n\n'
+output = '// Gerado por convert_template.py a partir de template.html. Não edite.\n'
+output += '#ifndef TEMPLATE_H\n#define TEMPLATE_H\n\n'
+output += '#include <assert.h>\n\n'
+output += '// Bytes fixos do HTML, sem os placeholders\n'
+output += '#define HTML_TEMPLATE_STATIC_LEN {}\n\n'.format(static_len)
+output += '// Tamanho máximo de cada placeholder, na ordem dos argumentos do template\n'
+for name, max_len in placeholders:
+    output += '#define HTML_{}_MAX {}\n'.format(name, max_len)
+output += '\n// Tamanho máximo do corpo HTML renderizado\n'
+output += '#define HTML_BODY_MAX_LEN (HTML_TEMPLATE_STATIC_LEN'
+for name, _ in placeholders:
+    output += ' + HTML_{}_MAX'.format(name)
+output += ')\n\n'
+output += 'const char html_template[] = \"' + fmt + '";\n\n'
+# Confere HTML_TEMPLATE_STATIC_LEN contra a string realmente emitida
+output += '// Cada placeholder ocupa 2 bytes ("%s") e cada \'%\' literal foi duplicado\n'
+output += 'static_assert(sizeof(html_template) - 1 - 2 * {} - {} == HTML_TEMPLATE_STATIC_LEN,\n'.format(len(placeholders), percent_count)
+output += '              "HTML_TEMPLATE_STATIC_LEN não corresponde a html_template");\n\n'
 output += '#endif // TEMPLATE_H\n'
 
 with open(output_file, 'w', encoding='utf-8') as f:
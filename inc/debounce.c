@@ -0,0 +1,94 @@
+#include "debounce.h"
+#include "hardware/pio.h"
+#include "hardware/clocks.h"
+#include "hardware/irq.h"
+#include "debounce.pio.h"
+#include <stdio.h>
+
+typedef struct {
+    uint gpio;
+    uint sm;
+    volatile uint32_t pulse_count;  // Bordas de descida qualificadas
+    debounce_callback_t callback;
+} debounce_channel_t;
+
+static debounce_channel_t channels[DEBOUNCE_MAX_CHANNELS];
+static uint channel_count = 0;
+static PIO debounce_pio = NULL;
+static uint debounce_offset = 0;
+
+static float sm_clkdiv(void) {
+    return (float)clock_get_hz(clk_sys) / DEBOUNCE_SM_HZ;
+}
+
+// Esvazia o RX FIFO de cada state machine: cada palavra é uma borda qualificada
+static void debounce_irq_handler(void) {
+    for (uint i = 0; i < channel_count; ++i) {
+        debounce_channel_t *ch = &channels[i];
+        while (!pio_sm_is_rx_fifo_empty(debounce_pio, ch->sm)) {
+            bool level = pio_sm_get(debounce_pio, ch->sm) != 0;
+            uint32_t timestamp_us = time_us_32();
+            if (!level) {
+                ch->pulse_count++;
+            }
+            if (ch->callback) {
+                ch->callback(ch->gpio, level, timestamp_us);
+            }
+        }
+    }
+}
+
+// Associa uma state machine ao pino (já configurado como entrada, com pull-up se necessário)
+bool debounce_init(uint gpio, uint32_t period_us, debounce_callback_t callback) {
+    if (channel_count == DEBOUNCE_MAX_CHANNELS) {
+        return false;
+    }
+    debounce_channel_t *ch = &channels[channel_count];
+    int sm;
+    if (debounce_pio == NULL) {
+        uint claimed_sm;
+        if (!pio_claim_free_sm_and_add_program(&debounce_program, &debounce_pio, &claimed_sm, &debounce_offset)) {
+            printf("Debounce: nenhuma PIO livre\n");
+            return false;
+        }
+        sm = claimed_sm;
+        uint irq = pio_get_irq_num(debounce_pio, 0);
+        irq_add_shared_handler(irq, debounce_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(irq, true);
+    } else {
+        sm = pio_claim_unused_sm(debounce_pio, false);
+        if (sm < 0) {
+            printf("Debounce: nenhuma state machine livre\n");
+            return false;
+        }
+    }
+
+    ch->gpio = gpio;
+    ch->sm = sm;
+    ch->pulse_count = 0;
+    ch->callback = callback;
+
+    debounce_program_init(debounce_pio, sm, debounce_offset, gpio, sm_clkdiv());
+    // Período de integração em iterações de 2 ciclos
+    pio_sm_put(debounce_pio, sm, period_us * (DEBOUNCE_SM_HZ / 1000000) / 2);
+    channel_count++;
+    pio_set_irqn_source_enabled(debounce_pio, 0, pio_get_rx_fifo_not_empty_interrupt_source(sm), true);
+    pio_sm_set_enabled(debounce_pio, sm, true);
+    return true;
+}
+
+// Mantém o período de integração após uma troca do clock do sistema
+void debounce_update_clock(void) {
+    for (uint i = 0; i < channel_count; ++i) {
+        pio_sm_set_clkdiv(debounce_pio, channels[i].sm, sm_clkdiv());
+    }
+}
+
+uint32_t debounce_get_pulse_count(uint gpio) {
+    for (uint i = 0; i < channel_count; ++i) {
+        if (channels[i].gpio == gpio) {
+            return channels[i].pulse_count;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,16 @@
+#ifndef DEBOUNCE_H
+#define DEBOUNCE_H
+
+#include "pico/stdlib.h"
+
+#define DEBOUNCE_MAX_CHANNELS  4         // Uma state machine da PIO por pino
+#define DEBOUNCE_SM_HZ         1000000   // Clock das state machines (1 iteração = 2 us)
+
+// Chamado na interrupção da PIO, uma vez por borda qualificada
+typedef void (*debounce_callback_t)(uint gpio, bool level, uint32_t timestamp_us);
+
+bool debounce_init(uint gpio, uint32_t period_us, debounce_callback_t callback);
+void debounce_update_clock(void);
+uint32_t debounce_get_pulse_count(uint gpio);
+
+#endif // DEBOUNCE_H
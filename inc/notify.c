@@ -0,0 +1,257 @@
+#include "notify.h"
+#include "pico/cyw43_arch.h"
+#include "lwip/pbuf.h"
+#include "lwip/udp.h"
+#include "lwip/tcp.h"
+#include <stdio.h>
+#include <string.h>
+
+// Evento na fila; eventos iguais e consecutivos são agrupados em uma entrada
+typedef struct {
+    uint8_t type;
+    uint16_t count;
+    uint32_t first_ms;
+    uint32_t last_ms;
+} notify_entry_t;
+
+static const char *const event_names[NOTIFY_EVENT_COUNT] = {
+    "motion",
+    "buzzer_on",
+    "buzzer_off",
+};
+
+// Fila circular; as 'inflight' primeiras entradas pertencem ao lote em envio
+static notify_entry_t queue[NOTIFY_QUEUE_SIZE];
+static uint8_t queue_head = 0;
+static uint8_t queue_count = 0;
+static uint8_t inflight = 0;
+
+static notify_stats_t stats;
+static ip_addr_t collector_addr;
+static bool collector_valid = false;
+static uint32_t batch_seq = 0;
+static uint32_t retry_delay_ms = NOTIFY_RETRY_BASE_MS;
+static uint32_t next_attempt_ms = 0;
+static bool retry_pending = false;   // next_attempt_ms só vale durante o backoff
+
+// Cabeçalho HTTP (opcional) + corpo do lote
+static char payload[512];
+
+#if NOTIFY_USE_HTTP
+static struct tcp_pcb *http_pcb = NULL;
+static uint16_t http_request_len = 0;
+#else
+static struct udp_pcb *udp_pcb = NULL;
+#endif
+
+static uint32_t now_ms(void) {
+    return to_ms_since_boot(get_absolute_time());
+}
+
+// Monta o corpo do lote: uma linha de cabeçalho e uma linha por evento
+static int build_batch(char *buf, size_t size) {
+    int len = snprintf(buf, size, "seq=%lu dropped=%lu\n",
+                       (unsigned long)batch_seq, (unsigned long)stats.dropped_events);
+    for (uint8_t i = 0; i < inflight && len < (int)size; ++i) {
+        const notify_entry_t *e = &queue[(queue_head + i) % NOTIFY_QUEUE_SIZE];
+        len += snprintf(buf + len, size - len, "%s %u %lu %lu\n",
+                        event_names[e->type], e->count,
+                        (unsigned long)e->first_ms, (unsigned long)e->last_ms);
+    }
+    return len < (int)size ? len : -1;
+}
+
+// Finaliza a tentativa atual: remove o lote da fila ou agenda nova tentativa
+static void batch_done(bool ok) {
+    if (ok) {
+        stats.sent_batches++;
+        stats.sent_events += inflight;
+        queue_head = (queue_head + inflight) % NOTIFY_QUEUE_SIZE;
+        queue_count -= inflight;
+        inflight = 0;
+        batch_seq++;
+        retry_delay_ms = NOTIFY_RETRY_BASE_MS;
+        retry_pending = false;
+    } else {
+        stats.failed_attempts++;
+        next_attempt_ms = now_ms() + retry_delay_ms;
+        retry_pending = true;
+        retry_delay_ms *= 2;
+        if (retry_delay_ms > NOTIFY_RETRY_MAX_MS) {
+            retry_delay_ms = NOTIFY_RETRY_MAX_MS;
+        }
+    }
+}
+
+#if NOTIFY_USE_HTTP
+// Encerra a conexão; retorna ERR_ABRT se o pcb precisou ser abortado
+static err_t http_finish(bool ok) {
+    err_t ret = ERR_OK;
+    if (http_pcb) {
+        tcp_arg(http_pcb, NULL);
+        tcp_recv(http_pcb, NULL);
+        tcp_err(http_pcb, NULL);
+        tcp_poll(http_pcb, NULL, 0);
+        if (tcp_close(http_pcb) != ERR_OK) {
+            tcp_abort(http_pcb);
+            ret = ERR_ABRT;
+        }
+        http_pcb = NULL;
+    }
+    batch_done(ok);
+    return ret;
+}
+
+// Só a linha de status importa: qualquer 2xx confirma o lote
+static err_t http_recv_callback(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err) {
+    if (p == NULL) {
+        return http_finish(false);
+    }
+    char status[12] = {0};
+    pbuf_copy_partial(p, status, sizeof(status) - 1, 0);
+    tcp_recved(tpcb, p->tot_len);
+    pbuf_free(p);
+    bool ok = strncmp(status, "HTTP/1.", 7) == 0 && status[9] == '2';
+    return http_finish(ok);
+}
+
+static err_t http_connected_callback(void *arg, struct tcp_pcb *tpcb, err_t err) {
+    if (err != ERR_OK ||
+        tcp_write(tpcb, payload, http_request_len, TCP_WRITE_FLAG_COPY) != ERR_OK) {
+        return http_finish(false);
+    }
+    tcp_output(tpcb);
+    return ERR_OK;
+}
+
+static err_t http_poll_callback(void *arg, struct tcp_pcb *tpcb) {
+    printf("Notificação: tempo esgotado no coletor\n");
+    return http_finish(false);
+}
+
+// O pcb já foi liberado pelo lwIP quando este callback é chamado
+static void http_err_callback(void *arg, err_t err) {
+    http_pcb = NULL;
+    batch_done(false);
+}
+
+static void send_batch(void) {
+    char body[384];
+    int body_len = build_batch(body, sizeof(body));
+    int len = body_len < 0 ? -1 : snprintf(payload, sizeof(payload),
+        "POST " NOTIFY_HTTP_PATH " HTTP/1.1\r\n"
+        "Host: " NOTIFY_COLLECTOR_IP "\r\n"
+        "Content-Type: text/plain\r\n"
+        "Content-Length: %d\r\n"
+        "Connection: close\r\n\r\n%s", body_len, body);
+    if (len < 0 || len >= (int)sizeof(payload)) {
+        batch_done(false);
+        return;
+    }
+    http_request_len = len;
+
+    http_pcb = tcp_new_ip_type(IPADDR_TYPE_ANY);
+    if (!http_pcb) {
+        batch_done(false);
+        return;
+    }
+    tcp_recv(http_pcb, http_recv_callback);
+    tcp_err(http_pcb, http_err_callback);
+    tcp_poll(http_pcb, http_poll_callback, NOTIFY_HTTP_TIMEOUT_MS / 500);
+    if (tcp_connect(http_pcb, &collector_addr, NOTIFY_COLLECTOR_PORT, http_connected_callback) != ERR_OK) {
+        http_finish(false);
+    }
+}
+#else
+// UDP não tem confirmação: o lote é entregue quando o lwIP aceita o datagrama
+static void send_batch(void) {
+    int len = build_batch(payload, sizeof(payload));
+    if (len < 0) {
+        batch_done(false);
+        return;
+    }
+    struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, len, PBUF_RAM);
+    if (!p) {
+        batch_done(false);
+        return;
+    }
+    pbuf_take(p, payload, len);
+    err_t err = udp_sendto(udp_pcb, p, &collector_addr, NOTIFY_COLLECTOR_PORT);
+    pbuf_free(p);
+    batch_done(err == ERR_OK);
+}
+#endif
+
+// Inicializa o destino das notificações (chamar após a conexão Wi-Fi)
+void notify_init(void) {
+    if (!ipaddr_aton(NOTIFY_COLLECTOR_IP, &collector_addr)) {
+        printf("Notificação: endereço do coletor inválido\n");
+        return;
+    }
+#if !NOTIFY_USE_HTTP
+    cyw43_arch_lwip_begin();
+    udp_pcb = udp_new();
+    cyw43_arch_lwip_end();
+    if (!udp_pcb) {
+        printf("Notificação: erro ao criar PCB UDP\n");
+        return;
+    }
+#endif
+    collector_valid = true;
+}
+
+// Enfileira um evento; agrupa com o último se for do mesmo tipo e ainda não estiver em envio
+void notify_event(notify_event_type_t type) {
+    uint32_t now = now_ms();
+    cyw43_arch_lwip_begin();
+    if (queue_count > inflight) {
+        notify_entry_t *last = &queue[(queue_head + queue_count - 1) % NOTIFY_QUEUE_SIZE];
+        if (last->type == type && last->count < UINT16_MAX) {
+            last->count++;
+            last->last_ms = now;
+            cyw43_arch_lwip_end();
+            return;
+        }
+    }
+    if (queue_count == NOTIFY_QUEUE_SIZE) {
+        stats.dropped_events++;
+    } else {
+        notify_entry_t *e = &queue[(queue_head + queue_count) % NOTIFY_QUEUE_SIZE];
+        e->type = type;
+        e->count = 1;
+        e->first_ms = now;
+        e->last_ms = now;
+        queue_count++;
+    }
+    cyw43_arch_lwip_end();
+}
+
+// Envia o próximo lote quando a janela de agrupamento e o backoff permitirem
+void notify_poll(void) {
+    if (!collector_valid) {
+        return;
+    }
+    uint32_t now = now_ms();
+    cyw43_arch_lwip_begin();
+#if NOTIFY_USE_HTTP
+    bool busy = http_pcb != NULL;
+#else
+    bool busy = false;
+#endif
+    if (!busy && queue_count > 0 && (!retry_pending || (int32_t)(now - next_attempt_ms) >= 0) &&
+        (queue_count >= NOTIFY_BATCH_MAX || inflight > 0 ||
+         now - queue[queue_head].first_ms >= NOTIFY_BATCH_DELAY_MS)) {
+        if (inflight == 0) {
+            inflight = queue_count < NOTIFY_BATCH_MAX ? queue_count : NOTIFY_BATCH_MAX;
+        }
+        send_batch();
+    }
+    cyw43_arch_lwip_end();
+}
+
+notify_stats_t notify_get_stats(void) {
+    cyw43_arch_lwip_begin();
+    notify_stats_t copy = stats;
+    cyw43_arch_lwip_end();
+    return copy;
+}
@@ -0,0 +1,45 @@
+#ifndef NOTIFY_H
+#define NOTIFY_H
+
+#include "pico/stdlib.h"
+
+// Coletor local que recebe as notificações
+#ifndef NOTIFY_COLLECTOR_IP
+#define NOTIFY_COLLECTOR_IP    "192.168.0.100"
+#endif
+#ifndef NOTIFY_COLLECTOR_PORT
+#define NOTIFY_COLLECTOR_PORT  5005
+#endif
+#ifndef NOTIFY_USE_HTTP
+#define NOTIFY_USE_HTTP        0        // 0 = datagrama UDP, 1 = HTTP POST
+#endif
+#define NOTIFY_HTTP_PATH       "/events"
+
+// Fila e envio em lotes
+#define NOTIFY_QUEUE_SIZE      16       // Eventos pendentes em RAM
+#define NOTIFY_BATCH_MAX       8        // Eventos por datagrama/POST
+#define NOTIFY_BATCH_DELAY_MS  500      // Janela de agrupamento após o primeiro evento
+#define NOTIFY_RETRY_BASE_MS   1000     // Primeiro intervalo de nova tentativa
+#define NOTIFY_RETRY_MAX_MS    60000    // Intervalo máximo (backoff exponencial)
+#define NOTIFY_HTTP_TIMEOUT_MS 5000     // Tempo máximo de uma tentativa HTTP
+
+typedef enum {
+    NOTIFY_EVENT_MOTION = 0,    // Sensor A detectou movimento
+    NOTIFY_EVENT_BUZZER_ON,     // Buzzer ligado remotamente
+    NOTIFY_EVENT_BUZZER_OFF,    // Buzzer desligado remotamente
+    NOTIFY_EVENT_COUNT
+} notify_event_type_t;
+
+typedef struct {
+    uint32_t sent_batches;      // Lotes confirmados pelo coletor
+    uint32_t sent_events;       // Eventos (já agrupados) entregues
+    uint32_t failed_attempts;   // Tentativas que falharam e serão repetidas
+    uint32_t dropped_events;    // Eventos descartados com a fila cheia
+} notify_stats_t;
+
+void notify_init(void);
+void notify_event(notify_event_type_t type);
+void notify_poll(void);
+notify_stats_t notify_get_stats(void);
+
+#endif // NOTIFY_H
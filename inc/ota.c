@@ -0,0 +1,464 @@
+#include "ota.h"
+#include "pico/cyw43_arch.h"
+#include "pico/flash.h"
+#include "hardware/sync.h"
+#include "hardware/watchdog.h"
+#include "hardware/structs/watchdog.h"
+#include <assert.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static_assert(OTA_RING_SIZE >= TCP_WND && (OTA_RING_SIZE & (OTA_RING_SIZE - 1)) == 0, "OTA_RING_SIZE inválido");
+
+typedef enum {
+    OTA_SESSION_IDLE = 0,
+    OTA_SESSION_RECEIVING,
+    OTA_SESSION_REBOOTING,
+} ota_session_state_t;
+
+// Upload em andamento. 'received', 'crc' e 'ring_head' são atualizados no contexto
+// do lwIP; 'written', 'erased' e 'ring_tail' apenas no loop principal
+static struct {
+    volatile ota_session_state_t state;
+    struct tcp_pcb *pcb;
+    volatile bool failed;
+    uint32_t size;
+    uint32_t expected_crc;
+    volatile uint32_t received;
+    uint32_t crc;
+    uint32_t written;
+    uint32_t erased;
+    uint32_t last_rx_ms;
+} session;
+
+// Anel de recepção
+static uint8_t ota_ring[OTA_RING_SIZE] __attribute__((aligned(4)));
+static volatile uint32_t ring_head = 0;
+static volatile uint32_t ring_tail = 0;
+static uint8_t ota_chunk[OTA_PROGRAM_CHUNK] __attribute__((aligned(4)));
+
+// Estado do meta lido no boot; a troca e o rollback são feitos pelo estágio de boot
+static ota_meta_t meta;
+static ota_phase_t boot_phase = OTA_PHASE_NONE;
+static bool trial_active = false;
+static volatile bool trial_confirmed = false;
+static uint32_t trial_start_ms = 0;
+static repeating_timer_t trial_timer;
+
+extern char __flash_binary_end;
+
+static uint32_t now_ms(void) {
+    return to_ms_since_boot(get_absolute_time());
+}
+
+// Tamanho da imagem em execução (fim do binário definido pelo linker)
+static uint32_t running_image_size(void) {
+    return (uintptr_t)&__flash_binary_end - (XIP_BASE + OTA_SLOT_A_OFFSET);
+}
+
+// ---------------------------------------------------------------------------
+// Acesso à flash (com a proteção do pico_flash)
+
+typedef struct {
+    uint32_t offset;
+    const uint8_t *data;    // NULL = apagar
+    size_t len;
+} flash_op_t;
+
+static void flash_op_callback(void *param) {
+    const flash_op_t *op = param;
+    if (op->data) {
+        flash_range_program(op->offset, op->data, op->len);
+    } else {
+        flash_range_erase(op->offset, op->len);
+    }
+}
+
+static bool flash_erase(uint32_t offset, size_t len) {
+    flash_op_t op = { offset, NULL, len };
+    return flash_safe_execute(flash_op_callback, &op, UINT32_MAX) == PICO_OK;
+}
+
+static bool flash_program(uint32_t offset, const uint8_t *data, size_t len) {
+    flash_op_t op = { offset, data, len };
+    return flash_safe_execute(flash_op_callback, &op, UINT32_MAX) == PICO_OK;
+}
+
+// Registra um novo upload; apaga o meta inteiro, descartando o log anterior
+static bool write_header(ota_header_t *h) {
+    ota_meta_header_page(h, ota_chunk);
+    return flash_erase(OTA_META_OFFSET, OTA_META_SIZE) &&
+           flash_program(OTA_META_OFFSET, ota_chunk, FLASH_PAGE_SIZE);
+}
+
+static bool log_append(ota_log_code_t code) {
+    uint32_t offset;
+    if (!ota_meta_log_page(&meta, code, &offset, ota_chunk) ||
+        !flash_program(offset, ota_chunk, FLASH_PAGE_SIZE)) {
+        return false;
+    }
+    meta.log_next++;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Período de teste da imagem nova
+
+// Alimenta o watchdog enquanto a imagem nova ainda tem prazo para se confirmar
+static bool trial_timer_callback(repeating_timer_t *rt) {
+    if (trial_confirmed) {
+        hw_clear_bits(&watchdog_hw->ctrl, WATCHDOG_CTRL_ENABLE_BITS);
+        return false;
+    }
+    if (now_ms() - trial_start_ms < OTA_TRIAL_TIMEOUT_MS) {
+        watchdog_update();
+    }
+    return true;
+}
+
+/*
+ * Deve ser a primeira chamada de main(). Se o estágio de boot acabou de
+ * instalar a imagem atual, ela está em teste: o watchdog armado por ele
+ * continua sendo alimentado até ota_confirm() ou até OTA_TRIAL_TIMEOUT_MS.
+ */
+void ota_boot_check(void) {
+    ota_meta_load(&meta);
+    boot_phase = ota_meta_phase(&meta);
+    if (boot_phase == OTA_PHASE_TRIAL) {
+        trial_active = true;
+        trial_start_ms = now_ms();
+        watchdog_enable(OTA_WATCHDOG_MS, true);
+        add_repeating_timer_ms(1000, trial_timer_callback, NULL, &trial_timer);
+    }
+}
+
+// A imagem em teste alcançou a rede: torna a atualização definitiva
+void ota_confirm(void) {
+    if (!trial_active) {
+        return;
+    }
+    if (log_append(OTA_LOG_CONFIRM)) {
+        trial_active = false;
+        trial_confirmed = true;
+        boot_phase = OTA_PHASE_UPDATED;
+        printf("OTA: imagem nova confirmada\n");
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Recepção do upload (POST /ota)
+
+static err_t respond_and_close(struct tcp_pcb *tpcb, const char *status, const char *message) {
+    char response[256];
+    int len = snprintf(response, sizeof(response),
+        "HTTP/1.1 %s\r\n"
+        "Content-Type: text/plain; charset=UTF-8\r\n"
+        "Content-Length: %d\r\n"
+        "Connection: close\r\n\r\n%s", status, (int)strlen(message), message);
+    if (len >= (int)sizeof(response)) {
+        len = sizeof(response) - 1;
+    }
+    tcp_arg(tpcb, NULL);
+    tcp_recv(tpcb, NULL);
+    tcp_err(tpcb, NULL);
+    tcp_poll(tpcb, NULL, 0);
+    tcp_write(tpcb, response, len, TCP_WRITE_FLAG_COPY);
+    tcp_output(tpcb);
+    if (tcp_close(tpcb) != ERR_OK) {
+        tcp_abort(tpcb);
+        return ERR_ABRT;
+    }
+    return ERR_OK;
+}
+
+// Copia até 'len' bytes do pbuf (a partir de 'offset') para o anel
+static void ring_push(struct pbuf *p, uint16_t offset, uint32_t len) {
+    uint32_t index = ring_head & (OTA_RING_SIZE - 1);
+    uint32_t first = len < OTA_RING_SIZE - index ? len : OTA_RING_SIZE - index;
+    pbuf_copy_partial(p, ota_ring + index, first, offset);
+    if (len > first) {
+        pbuf_copy_partial(p, ota_ring, len - first, offset + first);
+    }
+    session.crc = ota_crc32_update(session.crc, ota_ring + index, first);
+    if (len > first) {
+        session.crc = ota_crc32_update(session.crc, ota_ring, len - first);
+    }
+    ring_head += len;
+    session.received += len;
+    session.last_rx_ms = now_ms();
+}
+
+static void ring_pop(uint8_t *dst, uint32_t len) {
+    uint32_t index = ring_tail & (OTA_RING_SIZE - 1);
+    uint32_t first = len < OTA_RING_SIZE - index ? len : OTA_RING_SIZE - index;
+    memcpy(dst, ota_ring + index, first);
+    memcpy(dst + first, ota_ring, len - first);
+}
+
+static err_t ota_recv_callback(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err) {
+    if (p == NULL) {
+        // Cliente encerrou: só é erro se o corpo ainda não chegou inteiro
+        if (session.received < session.size) {
+            session.failed = true;
+        }
+        return ERR_OK;
+    }
+    uint32_t take = session.size - session.received;
+    if (take > p->tot_len) {
+        take = p->tot_len;
+    }
+    // Não cabe no anel: o lwIP reentrega este pbuf mais tarde
+    if (OTA_RING_SIZE - (ring_head - ring_tail) < take) {
+        return ERR_MEM;
+    }
+    ring_push(p, 0, take);
+    // Bytes além do corpo são descartados; os do corpo só são liberados após a gravação
+    if (p->tot_len > take) {
+        tcp_recved(tpcb, p->tot_len - take);
+    }
+    pbuf_free(p);
+    return ERR_OK;
+}
+
+// Chamado a cada 500 ms pelo lwIP: aborta uploads parados
+static err_t ota_poll_callback(void *arg, struct tcp_pcb *tpcb) {
+    if (session.received < session.size && now_ms() - session.last_rx_ms >= OTA_RX_TIMEOUT_MS) {
+        printf("OTA: tempo esgotado aguardando dados\n");
+        tcp_arg(tpcb, NULL);
+        tcp_recv(tpcb, NULL);
+        tcp_err(tpcb, NULL);
+        tcp_poll(tpcb, NULL, 0);
+        tcp_abort(tpcb);
+        session.pcb = NULL;
+        session.failed = true;
+        return ERR_ABRT;
+    }
+    return ERR_OK;
+}
+
+// O pcb já foi liberado pelo lwIP quando este callback é chamado
+static void ota_err_callback(void *arg, err_t err) {
+    session.pcb = NULL;
+    session.failed = true;
+}
+
+/*
+ * Assume a conexão de um "POST /ota". Exige Content-Length e X-Image-CRC32 (hex,
+ * zlib.crc32 da imagem .bin) no primeiro segmento; o corpo segue para o anel e é
+ * gravado no slot B por ota_poll().
+ */
+err_t ota_begin(struct tcp_pcb *tpcb, struct pbuf *p) {
+    static char headers[512];
+    uint16_t end = pbuf_memfind(p, "\r\n\r\n", 4, 0);
+    if (end == 0xFFFF || end >= sizeof(headers)) {
+        pbuf_free(p);
+        return respond_and_close(tpcb, "400 Bad Request", "Cabeçalhos incompletos\n");
+    }
+    pbuf_copy_partial(p, headers, end, 0);
+    headers[end] = '\0';
+    uint16_t body_offset = end + 4;
+
+    const char *length_field = strstr(headers, "Content-Length:");
+    const char *crc_field = strstr(headers, "X-Image-CRC32:");
+    uint32_t size = length_field ? strtoul(length_field + 15, NULL, 10) : 0;
+
+    const char *status = NULL;
+    const char *message = NULL;
+    if (session.state != OTA_SESSION_IDLE || trial_active) {
+        status = "409 Conflict";
+        message = "Atualização já em andamento\n";
+    } else if (running_image_size() > OTA_SLOT_SIZE) {
+        status = "503 Service Unavailable";
+        message = "Imagem atual maior que o slot\n";
+    } else if (!crc_field) {
+        status = "400 Bad Request";
+        message = "X-Image-CRC32 ausente\n";
+    } else if (size == 0 || size > OTA_SLOT_SIZE) {
+        status = "413 Payload Too Large";
+        message = "Tamanho de imagem inválido\n";
+    }
+    if (status) {
+        pbuf_free(p);
+        return respond_and_close(tpcb, status, message);
+    }
+
+    memset((void *)&session, 0, sizeof(session));
+    session.pcb = tpcb;
+    session.size = size;
+    session.expected_crc = strtoul(crc_field + 14, NULL, 16);
+    session.last_rx_ms = now_ms();
+    ring_head = 0;
+    ring_tail = 0;
+
+    tcp_arg(tpcb, NULL);
+    tcp_recv(tpcb, ota_recv_callback);
+    tcp_err(tpcb, ota_err_callback);
+    tcp_poll(tpcb, ota_poll_callback, 1);
+    if (strstr(headers, "Expect: 100-continue")) {
+        static const char continue_response[] = "HTTP/1.1 100 Continue\r\n\r\n";
+        tcp_write(tpcb, continue_response, sizeof(continue_response) - 1, 0);
+        tcp_output(tpcb);
+    }
+
+    // Cabeçalhos consumidos; o que vier do corpo neste segmento já vai para o anel
+    uint32_t body_len = p->tot_len > body_offset ? p->tot_len - body_offset : 0;
+    if (body_len > size) {
+        body_len = size;
+    }
+    ring_push(p, body_offset, body_len);
+    tcp_recved(tpcb, p->tot_len - body_len);
+    pbuf_free(p);
+
+    session.state = OTA_SESSION_RECEIVING;
+    printf("OTA: recebendo %lu bytes\n", (unsigned long)size);
+    return ERR_OK;
+}
+
+// Encerra o upload a partir do loop principal
+static void finish_session(const char *status, const char *message) {
+    cyw43_arch_lwip_begin();
+    if (session.pcb) {
+        respond_and_close(session.pcb, status, message);
+        session.pcb = NULL;
+    }
+    cyw43_arch_lwip_end();
+    printf("OTA: %s", message);
+}
+
+// Confere a imagem gravada e agenda a troca de slots no próximo boot
+static void verify_and_schedule(void) {
+    uint32_t crc = ota_crc32_update(0, (const uint8_t *)(XIP_BASE + OTA_SLOT_B_OFFSET), session.size);
+    if (crc != session.expected_crc || session.crc != session.expected_crc) {
+        finish_session("422 Unprocessable Entity", "CRC da imagem não confere\n");
+        session.state = OTA_SESSION_IDLE;
+        return;
+    }
+    // O CRC não garante que a imagem inicie: precisa ser um .bin linkado para o slot A
+    if (session.size < OTA_APP_VECTOR_OFFSET + 2 * sizeof(uint32_t) ||
+        !ota_meta_application_valid(OTA_SLOT_B_OFFSET)) {
+        finish_session("422 Unprocessable Entity", "Imagem não é uma aplicação linkada para o slot A\n");
+        session.state = OTA_SESSION_IDLE;
+        return;
+    }
+
+    uint32_t running_size = running_image_size();
+    uint32_t swap_size = session.size > running_size ? session.size : running_size;
+    ota_header_t h = {
+        .image_size = session.size,
+        .image_crc = session.expected_crc,
+        .swap_sectors = (swap_size + FLASH_SECTOR_SIZE - 1) / FLASH_SECTOR_SIZE,
+    };
+    if (!write_header(&h)) {
+        finish_session("500 Internal Server Error", "Falha ao gravar o estado da atualização\n");
+        session.state = OTA_SESSION_IDLE;
+        return;
+    }
+    finish_session("200 OK", "Imagem verificada, reiniciando\n");
+    session.state = OTA_SESSION_REBOOTING;
+    watchdog_reboot(0, 0, OTA_REBOOT_DELAY_MS);
+}
+
+/*
+ * Loop principal: uma operação de flash por chamada (apagar um setor ou gravar
+ * até OTA_PROGRAM_CHUNK bytes), para a rede ser atendida entre as pausas da flash.
+ * Setores são apagados à frente enquanto o anel espera dados, e a janela TCP só
+ * é liberada (tcp_recved) depois que os bytes chegam à flash.
+ */
+void ota_poll(void) {
+    if (session.state != OTA_SESSION_RECEIVING) {
+        return;
+    }
+    if (session.failed) {
+        cyw43_arch_lwip_begin();
+        if (session.pcb) {
+            tcp_arg(session.pcb, NULL);
+            tcp_recv(session.pcb, NULL);
+            tcp_err(session.pcb, NULL);
+            tcp_poll(session.pcb, NULL, 0);
+            tcp_abort(session.pcb);
+            session.pcb = NULL;
+        }
+        cyw43_arch_lwip_end();
+        printf("OTA: upload interrompido após %lu bytes\n", (unsigned long)session.received);
+        session.state = OTA_SESSION_IDLE;
+        return;
+    }
+
+    cyw43_arch_lwip_begin();
+    uint32_t avail = ring_head - ring_tail;
+    bool all_received = session.received == session.size;
+    cyw43_arch_lwip_end();
+
+    uint32_t erase_end = (session.size + FLASH_SECTOR_SIZE - 1) & ~(FLASH_SECTOR_SIZE - 1);
+    bool must_erase = session.erased <= session.written;
+    bool idle_erase = avail < FLASH_PAGE_SIZE && session.erased - session.written < OTA_ERASE_AHEAD;
+    if (session.erased < erase_end && (must_erase || idle_erase)) {
+        if (!flash_erase(OTA_SLOT_B_OFFSET + session.erased, FLASH_SECTOR_SIZE)) {
+            session.failed = true;
+            return;
+        }
+        session.erased += FLASH_SECTOR_SIZE;
+        return;
+    }
+
+    uint32_t len = avail;
+    if (len > OTA_PROGRAM_CHUNK) {
+        len = OTA_PROGRAM_CHUNK;
+    }
+    if (len > session.erased - session.written) {
+        len = session.erased - session.written;
+    }
+    uint32_t program_len = len & ~(FLASH_PAGE_SIZE - 1);
+    if (program_len == 0 && all_received && len == avail && len > 0) {
+        program_len = FLASH_PAGE_SIZE;  // Última página, completada com 0xFF
+    } else {
+        len = program_len;
+    }
+    if (program_len == 0) {
+        return;
+    }
+
+    ring_pop(ota_chunk, len);
+    memset(ota_chunk + len, 0xFF, program_len - len);
+    if (!flash_program(OTA_SLOT_B_OFFSET + session.written, ota_chunk, program_len)) {
+        session.failed = true;
+        return;
+    }
+    session.written += len;
+
+    cyw43_arch_lwip_begin();
+    ring_tail += len;
+    if (session.pcb) {
+        tcp_recved(session.pcb, len);
+    }
+    cyw43_arch_lwip_end();
+
+    if (session.written == session.size) {
+        verify_and_schedule();
+    }
+}
+
+bool ota_busy(void) {
+    return session.state != OTA_SESSION_IDLE;
+}
+
+ota_status_t ota_get_status(void) {
+    static const char *const states[] = { "idle", "receiving", "rebooting" };
+    static const char *const results[] = {
+        [OTA_PHASE_NONE] = "none",
+        [OTA_PHASE_SWAP] = "none",
+        [OTA_PHASE_TRIAL] = "trial",
+        [OTA_PHASE_UPDATED] = "updated",
+        [OTA_PHASE_REVERT] = "none",
+        [OTA_PHASE_ROLLED_BACK] = "rolled_back",
+    };
+    ota_status_t status = {
+        .state = states[session.state],
+        .last_result = results[boot_phase],
+        .received = session.received,
+        .written = session.written,
+    };
+    return status;
+}
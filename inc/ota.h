@@ -0,0 +1,30 @@
+#ifndef OTA_H
+#define OTA_H
+
+#include "pico/stdlib.h"
+#include "lwip/tcp.h"
+#include "ota_meta.h"       // Layout da flash e registro compartilhados com o estágio de boot
+
+#define OTA_RING_SIZE          16384    // Buffer de recepção (>= TCP_WND, potência de 2)
+#define OTA_PROGRAM_CHUNK      1024     // Bytes gravados por chamada de ota_poll()
+#define OTA_ERASE_AHEAD        (2 * FLASH_SECTOR_SIZE)  // Setores apagados à frente da escrita
+#define OTA_RX_TIMEOUT_MS      10000    // Upload sem dados por este tempo é abortado
+#define OTA_REBOOT_DELAY_MS    500      // Tempo para a resposta HTTP sair antes do reboot
+
+#define OTA_TRIAL_TIMEOUT_MS   60000    // Prazo para a imagem nova alcançar a rede
+
+typedef struct {
+    const char *state;          // "idle", "receiving" ou "rebooting"
+    const char *last_result;    // "none", "trial", "updated" ou "rolled_back"
+    uint32_t received;
+    uint32_t written;
+} ota_status_t;
+
+void ota_boot_check(void);
+void ota_confirm(void);
+err_t ota_begin(struct tcp_pcb *tpcb, struct pbuf *p);
+void ota_poll(void);
+bool ota_busy(void);
+ota_status_t ota_get_status(void);
+
+#endif // OTA_H
@@ -0,0 +1,114 @@
+#include "ota_meta.h"
+#include "hardware/regs/addressmap.h"
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+#define OTA_MAGIC              0x4F544132u  // "OTA2"
+#define OTA_LOG_OFFSET         (OTA_META_OFFSET + FLASH_PAGE_SIZE)
+#define OTA_LOG_WORDS          ((OTA_META_SIZE - FLASH_PAGE_SIZE) / 4)
+#define OTA_LOG_PAGE_WORDS     (FLASH_PAGE_SIZE / 4)
+
+static_assert(OTA_BOOT_SIZE % FLASH_SECTOR_SIZE == 0 && OTA_SLOT_SIZE % FLASH_SECTOR_SIZE == 0,
+              "boot e slots devem ser alinhados a setores");
+static_assert(OTA_SLOT_B_OFFSET + OTA_SLOT_SIZE <= OTA_SCRATCH_OFFSET, "slots invadem scratch/meta");
+// Ida e volta da troca, mais os boots em teste e alguma folga para gravações interrompidas
+static_assert(6 * OTA_SLOT_SECTORS + OTA_MAX_TRIAL_BOOTS + 16 <= OTA_LOG_WORDS,
+              "log de progresso pequeno para a troca");
+
+static const uint32_t crc_table[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+// CRC32 (IEEE, o mesmo de zlib.crc32), incremental a partir de crc = 0
+uint32_t ota_crc32_update(uint32_t crc, const uint8_t *data, size_t len) {
+    crc = ~crc;
+    while (len--) {
+        crc ^= *data++;
+        crc = (crc >> 4) ^ crc_table[crc & 0x0F];
+        crc = (crc >> 4) ^ crc_table[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+static uint32_t header_crc(const ota_header_t *h) {
+    return ota_crc32_update(0, (const uint8_t *)h, offsetof(ota_header_t, header_crc));
+}
+
+/*
+ * Lê o registro e percorre o log até a primeira palavra livre. Palavras com
+ * valor desconhecido (gravação interrompida por queda de energia) são
+ * ignoradas: um passo sem marca é simplesmente refeito.
+ */
+void ota_meta_load(ota_meta_t *m) {
+    memset(m, 0, sizeof(*m));
+    memcpy(&m->header, (const void *)(XIP_BASE + OTA_META_OFFSET), sizeof(m->header));
+    const ota_header_t *h = &m->header;
+    m->valid = h->magic == OTA_MAGIC && h->header_crc == header_crc(h) &&
+               h->image_size <= OTA_SLOT_SIZE &&
+               h->swap_sectors > 0 && h->swap_sectors <= OTA_SLOT_SECTORS;
+    if (!m->valid) {
+        return;
+    }
+
+    const uint32_t *log = (const uint32_t *)(XIP_BASE + OTA_LOG_OFFSET);
+    while (m->log_next < OTA_LOG_WORDS && log[m->log_next] != 0xFFFFFFFF) {
+        uint32_t code = log[m->log_next++];
+        if (code == OTA_LOG_STEP) {
+            m->steps++;
+        } else if (code == OTA_LOG_TRIAL) {
+            m->trials++;
+        } else if (code == OTA_LOG_CONFIRM) {
+            m->confirmed = true;
+        } else if (code == OTA_LOG_REVERT) {
+            m->reverting = true;
+        }
+    }
+}
+
+ota_phase_t ota_meta_phase(const ota_meta_t *m) {
+    uint32_t swap_steps = 3 * m->header.swap_sectors;
+    if (!m->valid) {
+        return OTA_PHASE_NONE;
+    }
+    if (m->steps < swap_steps) {
+        return OTA_PHASE_SWAP;
+    }
+    if (m->reverting) {
+        return m->steps < 2 * swap_steps ? OTA_PHASE_REVERT : OTA_PHASE_ROLLED_BACK;
+    }
+    return m->confirmed ? OTA_PHASE_UPDATED : OTA_PHASE_TRIAL;
+}
+
+/*
+ * Confere se a imagem no slot em 'slot_offset' é uma aplicação linkada para o
+ * slot A: pilha inicial na RAM e reset handler (Thumb) dentro do slot A. Uma
+ * imagem linkada em outro endereço (ex.: 0x10000000) passaria pelo CRC mas não
+ * inicia depois da troca.
+ */
+bool ota_meta_application_valid(uint32_t slot_offset) {
+    const uint32_t *vectors = (const uint32_t *)(XIP_BASE + slot_offset + OTA_APP_VECTOR_OFFSET);
+    uint32_t start = XIP_BASE + OTA_SLOT_A_OFFSET;
+    return vectors[0] > SRAM_BASE && vectors[0] <= SRAM_END &&
+           (vectors[1] & 1) && vectors[1] >= start && vectors[1] < start + OTA_SLOT_SIZE;
+}
+
+// Monta a página do registro em 'page' (FLASH_PAGE_SIZE bytes); o meta deve ser apagado antes
+void ota_meta_header_page(ota_header_t *h, uint8_t *page) {
+    h->magic = OTA_MAGIC;
+    h->header_crc = header_crc(h);
+    memset(page, 0xFF, FLASH_PAGE_SIZE);
+    memcpy(page, h, sizeof(*h));
+}
+
+// Monta em 'page' a gravação da próxima palavra do log (0xFF preserva as já gravadas)
+bool ota_meta_log_page(const ota_meta_t *m, ota_log_code_t code, uint32_t *offset, uint8_t *page) {
+    if (m->log_next >= OTA_LOG_WORDS) {
+        return false;
+    }
+    memset(page, 0xFF, FLASH_PAGE_SIZE);
+    ((uint32_t *)page)[m->log_next % OTA_LOG_PAGE_WORDS] = code;
+    *offset = OTA_LOG_OFFSET + (m->log_next / OTA_LOG_PAGE_WORDS) * FLASH_PAGE_SIZE;
+    return true;
+}
@@ -0,0 +1,77 @@
+#ifndef OTA_META_H
+#define OTA_META_H
+
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+
+/*
+ * Layout da flash (2 MB no Pico W). OTA_BOOT_SIZE e OTA_SLOT_SIZE vêm do
+ * CMakeLists.txt, que também gera os linker scripts a partir deles:
+ *   boot     [0, OTA_BOOT_SIZE)      estágio de boot (ota_boot.c), nunca regravado
+ *   slot A   OTA_SLOT_A_OFFSET       imagem em execução (a aplicação é linkada aqui)
+ *   slot B   OTA_SLOT_B_OFFSET       imagem recebida / imagem anterior
+ *   scratch  setor abaixo do meta    cópia temporária durante a troca
+ *   meta     dois últimos setores    registro da atualização + log de progresso
+ */
+#if !defined(OTA_BOOT_SIZE) || !defined(OTA_SLOT_SIZE)
+#error "OTA_BOOT_SIZE e OTA_SLOT_SIZE são definidos no CMakeLists.txt"
+#endif
+#define OTA_SLOT_A_OFFSET      OTA_BOOT_SIZE
+#define OTA_SLOT_B_OFFSET      (OTA_SLOT_A_OFFSET + OTA_SLOT_SIZE)
+#define OTA_META_SIZE          (2 * FLASH_SECTOR_SIZE)
+#define OTA_META_OFFSET        (PICO_FLASH_SIZE_BYTES - OTA_META_SIZE)
+#define OTA_SCRATCH_OFFSET     (OTA_META_OFFSET - FLASH_SECTOR_SIZE)
+#define OTA_SLOT_SECTORS       (OTA_SLOT_SIZE / FLASH_SECTOR_SIZE)
+
+// A imagem linkada para o slot A começa pelo boot2 (256 bytes, não usado); os vetores vêm depois
+#define OTA_APP_VECTOR_OFFSET  256
+
+#define OTA_MAX_TRIAL_BOOTS    3        // Boots sem confirmação antes do rollback
+#define OTA_WATCHDOG_MS        8000     // Watchdog da troca e do período de teste
+
+// Registro gravado na primeira página do meta quando um upload é aceito
+typedef struct {
+    uint32_t magic;
+    uint32_t image_size;
+    uint32_t image_crc;
+    uint32_t swap_sectors;
+    uint32_t header_crc;    // CRC32 dos campos anteriores
+} ota_header_t;
+
+// Depois do registro, o meta é só acrescentado: cada palavra do log é gravada
+// uma única vez com um destes códigos, sem apagar o setor
+typedef enum {
+    OTA_LOG_STEP    = 0x53544550,   // Um passo da troca concluído ("STEP")
+    OTA_LOG_TRIAL   = 0x54524941,   // Um boot da imagem nova em teste ("TRIA")
+    OTA_LOG_CONFIRM = 0x434F4E46,   // Imagem nova confirmada pela aplicação ("CONF")
+    OTA_LOG_REVERT  = 0x52455654,   // Rollback decidido pelo estágio de boot ("REVT")
+} ota_log_code_t;
+
+typedef enum {
+    OTA_PHASE_NONE = 0,     // Nenhuma atualização registrada
+    OTA_PHASE_SWAP,         // Troca para a imagem nova pendente ou interrompida
+    OTA_PHASE_TRIAL,        // Imagem nova no slot A aguardando confirmação
+    OTA_PHASE_UPDATED,      // Imagem nova confirmada
+    OTA_PHASE_REVERT,       // Troca de volta (rollback) pendente ou interrompida
+    OTA_PHASE_ROLLED_BACK,  // Imagem anterior restaurada
+} ota_phase_t;
+
+// Estado lido do meta
+typedef struct {
+    bool valid;
+    ota_header_t header;
+    uint32_t steps;         // Passos concluídos: 3 por setor em cada sentido da troca
+    uint32_t trials;
+    bool confirmed;
+    bool reverting;
+    uint32_t log_next;      // Índice da próxima palavra livre do log
+} ota_meta_t;
+
+uint32_t ota_crc32_update(uint32_t crc, const uint8_t *data, size_t len);
+void ota_meta_load(ota_meta_t *m);
+ota_phase_t ota_meta_phase(const ota_meta_t *m);
+void ota_meta_header_page(ota_header_t *h, uint8_t *page);
+bool ota_meta_log_page(const ota_meta_t *m, ota_log_code_t code, uint32_t *offset, uint8_t *page);
+bool ota_meta_application_valid(uint32_t slot_offset);
+
+#endif // OTA_META_H
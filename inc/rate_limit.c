@@ -0,0 +1,105 @@
+#include "rate_limit.h"
+
+#define TOKEN 1000  // Tokens em milésimos: a recarga é feita por milissegundo
+
+typedef struct {
+    uint32_t ip;                        // 0 = entrada nunca usada
+    uint32_t last_ms;
+    int32_t tokens[RATE_LANE_COUNT];
+} rate_entry_t;
+
+static const int32_t lane_burst[RATE_LANE_COUNT] = {
+    RATE_LIMIT_PAGE_BURST * TOKEN,
+    RATE_LIMIT_COMMAND_BURST * TOKEN,
+};
+static const int32_t lane_rate[RATE_LANE_COUNT] = {
+    RATE_LIMIT_PAGE_PER_SEC,            // milésimos de token por ms
+    RATE_LIMIT_COMMAND_PER_SEC,
+};
+
+// Tabela de endereçamento aberto (sondagem linear); entradas nunca são removidas,
+// apenas reaproveitadas quando ociosas, para não quebrar as cadeias de sondagem
+static rate_entry_t table[RATE_LIMIT_TABLE_SIZE];
+// Balde compartilhado pelos clientes que não couberem na tabela
+static rate_entry_t overflow_entry;
+static bool overflow_used = false;
+static rate_limit_stats_t stats;
+
+static void reset_entry(rate_entry_t *e, uint32_t ip, uint32_t now) {
+    e->ip = ip;
+    e->last_ms = now;
+    for (int lane = 0; lane < RATE_LANE_COUNT; ++lane) {
+        e->tokens[lane] = lane_burst[lane];
+    }
+}
+
+static void refill(rate_entry_t *e, uint32_t now) {
+    uint32_t elapsed = now - e->last_ms;
+    e->last_ms = now;
+    for (int lane = 0; lane < RATE_LANE_COUNT; ++lane) {
+        int64_t tokens = e->tokens[lane] + (int64_t)elapsed * lane_rate[lane];
+        e->tokens[lane] = tokens > lane_burst[lane] ? lane_burst[lane] : (int32_t)tokens;
+    }
+}
+
+static rate_entry_t *lookup(uint32_t ip, uint32_t now) {
+    // Hash multiplicativo: os bits altos dependem de todos os octetos do endereço
+    // (os baixos, só do primeiro octeto, igual para toda a rede local)
+    uint32_t index = (ip * 2654435761u) >> (32 - RATE_LIMIT_TABLE_BITS);
+    rate_entry_t *reusable = NULL;
+    for (uint32_t probe = 0; probe < RATE_LIMIT_TABLE_SIZE; ++probe) {
+        rate_entry_t *e = &table[(index + probe) & (RATE_LIMIT_TABLE_SIZE - 1)];
+        if (e->ip == ip) {
+            refill(e, now);
+            return e;
+        }
+        if (e->ip == 0) {
+            if (!reusable) {
+                reusable = e;
+            }
+            break;
+        }
+        if (!reusable && now - e->last_ms >= RATE_LIMIT_IDLE_MS) {
+            reusable = e;
+        }
+    }
+    if (reusable) {
+        reset_entry(reusable, ip, now);
+        return reusable;
+    }
+    stats.table_full++;
+    if (!overflow_used) {
+        reset_entry(&overflow_entry, 0, now);
+        overflow_used = true;
+    }
+    refill(&overflow_entry, now);
+    return &overflow_entry;
+}
+
+// Recusa a conexão só se o cliente não tiver token em nenhuma das filas
+bool rate_limit_accept(uint32_t ip) {
+    rate_entry_t *e = lookup(ip, to_ms_since_boot(get_absolute_time()));
+    for (int lane = 0; lane < RATE_LANE_COUNT; ++lane) {
+        if (e->tokens[lane] >= TOKEN) {
+            return true;
+        }
+    }
+    stats.rejected_connections++;
+    return false;
+}
+
+// Consome um token da fila da requisição; páginas nunca gastam tokens de comandos
+bool rate_limit_request(uint32_t ip, rate_lane_t lane) {
+    rate_entry_t *e = lookup(ip, to_ms_since_boot(get_absolute_time()));
+    if (e->tokens[lane] < TOKEN) {
+        stats.limited[lane]++;
+        return false;
+    }
+    e->tokens[lane] -= TOKEN;
+    stats.allowed[lane]++;
+    return true;
+}
+
+rate_limit_stats_t rate_limit_get_stats(void) {
+    return stats;
+}
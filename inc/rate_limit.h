@@ -0,0 +1,42 @@
+#ifndef RATE_LIMIT_H
+#define RATE_LIMIT_H
+
+#include "pico/stdlib.h"
+
+// Limites por cliente (token bucket); comandos têm balde próprio
+#ifndef RATE_LIMIT_PAGE_BURST
+#define RATE_LIMIT_PAGE_BURST       6       // Páginas em rajada
+#endif
+#ifndef RATE_LIMIT_PAGE_PER_SEC
+#define RATE_LIMIT_PAGE_PER_SEC     2       // Páginas por segundo, em regime
+#endif
+#ifndef RATE_LIMIT_COMMAND_BURST
+#define RATE_LIMIT_COMMAND_BURST    10      // Comandos em rajada
+#endif
+#ifndef RATE_LIMIT_COMMAND_PER_SEC
+#define RATE_LIMIT_COMMAND_PER_SEC  5       // Comandos por segundo, em regime
+#endif
+
+#define RATE_LIMIT_TABLE_BITS       4
+#define RATE_LIMIT_TABLE_SIZE       (1u << RATE_LIMIT_TABLE_BITS)   // Clientes rastreados
+#define RATE_LIMIT_IDLE_MS          60000   // Entrada ociosa pode ser reutilizada
+
+typedef enum {
+    RATE_LANE_PAGE = 0,     // Páginas, status e framebuffer
+    RATE_LANE_COMMAND,      // Comandos que mudam estado (LEDs, buzzer)
+    RATE_LANE_COUNT
+} rate_lane_t;
+
+typedef struct {
+    uint32_t allowed[RATE_LANE_COUNT];
+    uint32_t limited[RATE_LANE_COUNT];
+    uint32_t rejected_connections;  // Recusadas já no accept
+    uint32_t table_full;            // Clientes tratados pelo balde compartilhado
+} rate_limit_stats_t;
+
+// Todas as funções devem ser chamadas no contexto do lwIP (callbacks ou com o lock)
+bool rate_limit_accept(uint32_t ip);
+bool rate_limit_request(uint32_t ip, rate_lane_t lane);
+rate_limit_stats_t rate_limit_get_stats(void);
+
+#endif // RATE_LIMIT_H
@@ -188,4 +188,34 @@ void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y)
           break;
       }
   }
-}
\ No newline at end of file
+}
+
+/*
+ * Codifica o framebuffer em RLE numa única passada, direto de ram_buffer:
+ * cabeçalho [largura, páginas] seguido de pares [contagem 1..255, byte].
+ * A saída passa por um bloco fixo na pilha e é entregue a 'write' em partes.
+ */
+bool ssd1306_rle_encode(ssd1306_t *ssd, ssd1306_write_fn write, void *ctx) {
+  uint8_t chunk[64];
+  size_t used = 0;
+  chunk[used++] = ssd->width;
+  chunk[used++] = ssd->pages;
+
+  size_t i = 1;
+  while (i < ssd->bufsize) {
+    uint8_t value = ssd->ram_buffer[i];
+    uint8_t run = 1;
+    while (i + run < ssd->bufsize && run < 255 && ssd->ram_buffer[i + run] == value)
+      ++run;
+    i += run;
+
+    if (used + 2 > sizeof(chunk)) {
+      if (!write(ctx, chunk, used))
+        return false;
+      used = 0;
+    }
+    chunk[used++] = run;
+    chunk[used++] = value;
+  }
+  return write(ctx, chunk, used);
+}
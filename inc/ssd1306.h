@@ -34,6 +34,12 @@ typedef struct {
   uint8_t port_buffer[2];
 } ssd1306_t;
 
+// Destino do codificador RLE; retorna false para abortar a codificação
+typedef bool (*ssd1306_write_fn)(void *ctx, const uint8_t *data, size_t len);
+
+// Pior caso da saída RLE: cabeçalho de 2 bytes + um par (contagem, byte) por byte
+#define SSD1306_RLE_MAX_SIZE(ssd) (2 + 2 * ((ssd)->bufsize - 1))
+
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
 void ssd1306_config(ssd1306_t *ssd);
 void ssd1306_command(ssd1306_t *ssd, uint8_t command);
@@ -46,4 +52,5 @@ void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1
 void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value);
 void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value);
 void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y);
-void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
\ No newline at end of file
+void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
+bool ssd1306_rle_encode(ssd1306_t *ssd, ssd1306_write_fn write, void *ctx);
@@ -0,0 +1,133 @@
+// Estágio de boot para a atualização OTA.
+//
+// Ocupa os primeiros OTA_BOOT_SIZE bytes da flash e nunca é regravado pela
+// atualização. A cada boot, conclui (ou retoma, após uma queda de energia) a
+// troca dos slots A e B registrada no setor meta, conta os boots da imagem em
+// teste, decide o rollback e, por fim, salta para a aplicação no slot A.
+#include "pico/stdlib.h"
+#include "pico/bootrom.h"     // Para a função reset_usb_boot()
+#include "hardware/flash.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hardware/watchdog.h"
+#include "hardware/structs/nvic.h"
+#include "hardware/structs/scb.h"
+#include "hardware/structs/systick.h"
+#include <string.h>
+#include "inc/ota_meta.h"
+
+// Buffer de um setor para as cópias; a página do log fica separada
+static uint8_t sector_buffer[FLASH_SECTOR_SIZE] __attribute__((aligned(4)));
+static uint8_t log_buffer[FLASH_PAGE_SIZE] __attribute__((aligned(4)));
+
+// O estágio de boot roda da flash: basta não haver interrupções durante a gravação
+static void flash_erase(uint32_t offset, size_t len) {
+    uint32_t irq = save_and_disable_interrupts();
+    flash_range_erase(offset, len);
+    restore_interrupts(irq);
+}
+
+static void flash_program(uint32_t offset, const uint8_t *data, size_t len) {
+    uint32_t irq = save_and_disable_interrupts();
+    flash_range_program(offset, data, len);
+    restore_interrupts(irq);
+}
+
+static void copy_sector(uint32_t dst, uint32_t src) {
+    memcpy(sector_buffer, (const void *)(XIP_BASE + src), FLASH_SECTOR_SIZE);
+    flash_erase(dst, FLASH_SECTOR_SIZE);
+    flash_program(dst, sector_buffer, FLASH_SECTOR_SIZE);
+}
+
+static bool log_append(ota_meta_t *m, ota_log_code_t code) {
+    uint32_t offset;
+    if (!ota_meta_log_page(m, code, &offset, log_buffer)) {
+        return false;
+    }
+    flash_program(offset, log_buffer, FLASH_PAGE_SIZE);
+    m->log_next++;
+    return true;
+}
+
+/*
+ * Troca A <-> B setor a setor usando o setor scratch até 'steps' alcançar
+ * 'target'. Cada setor leva três passos (A->scratch, B->A, scratch->B), cada
+ * um refeito por inteiro se interrompido, e só é marcado no log depois de
+ * concluído. A troca é simétrica: o rollback repete a mesma sequência.
+ */
+static void run_swap(ota_meta_t *m, uint32_t target) {
+    uint32_t swap_steps = 3 * m->header.swap_sectors;
+    watchdog_enable(OTA_WATCHDOG_MS, true);
+    while (m->steps < target) {
+        uint32_t step = m->steps % swap_steps;
+        uint32_t offset = (step / 3) * FLASH_SECTOR_SIZE;
+        uint32_t phase = step % 3;
+        if (phase == 0) {
+            copy_sector(OTA_SCRATCH_OFFSET, OTA_SLOT_A_OFFSET + offset);
+        } else if (phase == 1) {
+            copy_sector(OTA_SLOT_A_OFFSET + offset, OTA_SLOT_B_OFFSET + offset);
+        } else {
+            copy_sector(OTA_SLOT_B_OFFSET + offset, OTA_SCRATCH_OFFSET);
+        }
+        if (!log_append(m, OTA_LOG_STEP)) {
+            break;
+        }
+        m->steps++;
+        watchdog_update();
+    }
+    hw_clear_bits(&watchdog_hw->ctrl, WATCHDOG_CTRL_ENABLE_BITS);
+}
+
+static void __attribute__((noreturn)) start_application(const uint32_t *vectors) {
+    // Devolve o núcleo como saiu do reset: sem interrupções pendentes ou habilitadas
+    systick_hw->csr = 0;
+    irq_set_mask_enabled(0xFFFFFFFF, false);
+    nvic_hw->icpr = 0xFFFFFFFF;
+    scb_hw->vtor = (uintptr_t)vectors;
+    __asm volatile (
+        "msr msp, %0\n"
+        "bx %1\n"
+        :: "r" (vectors[0]), "r" (vectors[1]));
+    __builtin_unreachable();
+}
+
+int main() {
+    // Um reboot pelo watchdog pode deixá-lo armado: a troca o rearma por conta própria
+    hw_clear_bits(&watchdog_hw->ctrl, WATCHDOG_CTRL_ENABLE_BITS);
+
+    ota_meta_t meta;
+    ota_meta_load(&meta);
+    uint32_t swap_steps = 3 * meta.header.swap_sectors;
+
+    switch (ota_meta_phase(&meta)) {
+    case OTA_PHASE_SWAP:
+        run_swap(&meta, swap_steps);
+        if (meta.steps < swap_steps) {
+            break;
+        }
+        // Troca concluída: a imagem nova começa o período de teste
+        // fall through
+    case OTA_PHASE_TRIAL:
+        if (meta.trials >= OTA_MAX_TRIAL_BOOTS || !ota_meta_application_valid(OTA_SLOT_A_OFFSET)) {
+            // Não se confirmou em nenhuma tentativa (ou nem é executável): volta para a imagem anterior
+            if (log_append(&meta, OTA_LOG_REVERT)) {
+                run_swap(&meta, 2 * swap_steps);
+            }
+        } else if (log_append(&meta, OTA_LOG_TRIAL)) {
+            // A aplicação assume a alimentação em ota_boot_check()
+            watchdog_enable(OTA_WATCHDOG_MS, true);
+        }
+        break;
+    case OTA_PHASE_REVERT:
+        run_swap(&meta, 2 * swap_steps);
+        break;
+    default:
+        break;
+    }
+
+    if (!ota_meta_application_valid(OTA_SLOT_A_OFFSET)) {
+        // Sem aplicação no slot A e nada a restaurar: aguarda uma nova gravação via USB
+        reset_usb_boot(0, 0);
+    }
+    start_application((const uint32_t *)(XIP_BASE + OTA_SLOT_A_OFFSET + OTA_APP_VECTOR_OFFSET));
+}
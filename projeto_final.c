@@ -6,10 +6,18 @@
 #include "hardware/gpio.h"
 #include "hardware/pwm.h"     // Para controle do PWM do buzzer
 #include "hardware/i2c.h"     // Para comunicação I2C com o display
+#include "hardware/clocks.h"  // Para a troca do clock do sistema no modo de baixo consumo
+#include "hardware/uart.h"    // Para reajustar o baud rate da UART após a troca de clock
+#include "hardware/sync.h"    // Para __sev()
 #include <string.h>
 #include <stdio.h>
+#include <assert.h>
 #include "inc/ssd1306.h"      // Biblioteca do display SSD1306
 #include "inc/font.h"         // Fonte utilizada pelo display
+#include "inc/notify.h"       // Notificações de eventos para o coletor local
+#include "inc/debounce.h"     // Debounce dos sensores via PIO
+#include "inc/rate_limit.h"   // Limite de requisições por cliente
+#include "inc/ota.h"          // Atualização de firmware via HTTP
 #include "template.h"
 
 // Configuração do I2C para o display OLED
@@ -29,28 +37,62 @@
 #define WIFI_SSID "NomeDaRede"          // Nome da rede Wi-Fi
 #define WIFI_PASS "SenhaDaRede"      // Senha da rede Wi-Fi
 
-// Mensagens de estado
-char sensor1_message[50] = "Nenhum movimento (Sensor A)";
-char sensor2_message[50] = "Botão B: pressione para BOOTSEL";
-
-// Buffer para resposta HTTP com HTML estilizado
-char http_response[10240];
-char html_body[10240];
+// Modo de baixo consumo (armado/ocioso)
+#define SYS_CLOCK_FULL_KHZ  125000  // Clock normal do sistema (125 MHz)
+#define SYS_CLOCK_IDLE_KHZ  48000   // Clock reduzido no modo ocioso (48 MHz)
+#define IDLE_TIMEOUT_MS     60000   // Tempo sem atividade até entrar no modo ocioso
+#define IDLE_WAKE_CHECK_MS  1000    // Espera máxima por evento no modo ocioso
+
+// Mensagens de estado (limitadas pelos placeholders {{NOME:MAX}} de template.html)
+#define SENSOR1_MSG_IDLE    "Nenhum movimento (Sensor A)"
+#define SENSOR1_MSG_MOTION  "Movimento detectado!"
+#define SENSOR2_MSG_IDLE    "Botão B: pressione para BOOTSEL"
+#define SENSOR2_MSG_BOOTSEL "Entrando em BOOTSEL..."
+
+static_assert(sizeof(SENSOR1_MSG_IDLE) - 1 <= HTML_SENSOR1_MESSAGE_MAX, "SENSOR1_MSG_IDLE excede o placeholder");
+static_assert(sizeof(SENSOR1_MSG_MOTION) - 1 <= HTML_SENSOR1_MESSAGE_MAX, "SENSOR1_MSG_MOTION excede o placeholder");
+static_assert(sizeof(SENSOR2_MSG_IDLE) - 1 <= HTML_SENSOR2_MESSAGE_MAX, "SENSOR2_MSG_IDLE excede o placeholder");
+static_assert(sizeof(SENSOR2_MSG_BOOTSEL) - 1 <= HTML_SENSOR2_MESSAGE_MAX, "SENSOR2_MSG_BOOTSEL excede o placeholder");
+
+char sensor1_message[HTML_SENSOR1_MESSAGE_MAX + 1] = SENSOR1_MSG_IDLE;
+char sensor2_message[HTML_SENSOR2_MESSAGE_MAX + 1] = SENSOR2_MSG_IDLE;
+
+// Header HTTP da página; %5d comporta qualquer HTML_BODY_MAX_LEN abaixo de 100000
+#define HTTP_HEADER_FMT \
+    "HTTP/1.1 200 OK\r\n" \
+    "Cache-Control: no-cache, no-store, must-revalidate\r\n" \
+    "Pragma: no-cache\r\n" \
+    "Expires: 0\r\n" \
+    "Content-Length: %5d\r\n" \
+    "Content-Type: text/html; charset=UTF-8\r\n" \
+    "Connection: close\r\n\r\n"
+#define HTTP_HEADER_LEN (sizeof(HTTP_HEADER_FMT) - 1 - 3 + 5)
+
+static_assert(HTML_BODY_MAX_LEN < 100000, "Content-Length não cabe em %5d");
+
+// Buffer para resposta HTTP com HTML estilizado (header + corpo, sem sobra)
+char http_response[HTTP_HEADER_LEN + HTML_BODY_MAX_LEN + 1];
 
 // Controle do alarme disparado pelo sensor A
 volatile bool sensor_alarm_triggered = false;
 uint32_t alarm_start_ms = 0;
 const uint32_t ALARM_DURATION_MS = 2000; // 2 segundos
 
-// Variáveis para debounce via interrupção (em milissegundos)
-volatile uint32_t last_interrupt_time_sensor1 = 0;
-volatile uint32_t last_interrupt_time_sensor2 = 0;
-const uint32_t debounce_delay_ms = 50;
+// Período de integração do debounce feito pela PIO (em microssegundos)
+#define DEBOUNCE_PERIOD_US  10000
 
 // Flags atualizadas pelas interrupções indicando o estado dos botões
 volatile bool sensor1_pressed = false;  // Botão A
 volatile bool sensor2_pressed = false;  // Botão B
 
+// Controle do modo de baixo consumo
+volatile bool wake_requested = false;   // Sinalizado por borda de sensor ou requisição HTTP
+bool low_power_active = false;
+uint32_t last_activity_ms = 0;
+
+// Frequência atual do buzzer (0 = desligado), reaplicada após troca de clock
+uint buzzer_frequency = 0;
+
 // Instância do display OLED
 static ssd1306_t ssd;
 
@@ -60,53 +102,157 @@ void buzzer_start(uint frequency) {
     uint channel = pwm_gpio_to_channel(BUZZER_PIN);  // Obtém o canal correto
     gpio_set_function(BUZZER_PIN, GPIO_FUNC_PWM);
     float divider = 125.0f;             // Divisor fixo
-    uint32_t clock = 125000000;         // Clock padrão do Pico (125 MHz)
+    uint32_t clock = clock_get_hz(clk_sys);  // Clock atual (muda no modo de baixo consumo)
     uint32_t wrap = clock / (divider * frequency) - 1;
     pwm_set_clkdiv(slice_num, divider);
     pwm_set_wrap(slice_num, wrap);
     pwm_set_chan_level(slice_num, channel, (wrap + 1) / 2);  // Duty cycle de 50%
     pwm_set_enabled(slice_num, true);
+    buzzer_frequency = frequency;
 }
 
 void buzzer_stop() {
     uint slice_num = pwm_gpio_to_slice_num(BUZZER_PIN);
     pwm_set_enabled(slice_num, false);
+    buzzer_frequency = 0;
 }
 
-// Callback de interrupção para os botões (sensores)
-void gpio_callback(uint gpio, uint32_t events) {
-    uint32_t current_time = to_ms_since_boot(get_absolute_time());
+// Callback da PIO para os botões (sensores): chamado uma vez por borda já sem rebote
+void sensor_edge_callback(uint gpio, bool level, uint32_t timestamp_us) {
     if (gpio == BUTTON1_PIN) {
-        if (current_time - last_interrupt_time_sensor1 < debounce_delay_ms) return;
-        last_interrupt_time_sensor1 = current_time;
-        sensor1_pressed = (gpio_get(BUTTON1_PIN) == 0);  // Botão com pull-up: pressionado = 0
+        sensor1_pressed = !level;  // Botão com pull-up: pressionado = 0
     } else if (gpio == BUTTON2_PIN) {
-        if (current_time - last_interrupt_time_sensor2 < debounce_delay_ms) return;
-        last_interrupt_time_sensor2 = current_time;
-        sensor2_pressed = (gpio_get(BUTTON2_PIN) == 0);
+        sensor2_pressed = !level;
     }
+    // Qualquer borda válida acorda o loop principal do modo ocioso
+    wake_requested = true;
+    __sev();
 }
 
-// Função para criar a resposta HTTP com HTML estilizado
-void create_http_response() {
-    // Preenche o corpo HTML substituindo os placeholders (%s)
-    snprintf(html_body, sizeof(html_body), html_template, sensor1_message, sensor2_message);
+// Função para criar a resposta HTTP com HTML estilizado; retorna o tamanho total ou -1
+int create_http_response() {
+    // O tamanho do corpo é conhecido antes de renderizar: parte fixa + mensagens
+    int body_length = HTML_TEMPLATE_STATIC_LEN + strlen(sensor1_message) + strlen(sensor2_message);
+
+    // Header com Content-Length de largura fixa, seguido do corpo no mesmo buffer
+    int header_length = snprintf(http_response, sizeof(http_response), HTTP_HEADER_FMT, body_length);
+    int written = snprintf(http_response + header_length, sizeof(http_response) - header_length,
+                           html_template, sensor1_message, sensor2_message);
+    if (header_length != (int)HTTP_HEADER_LEN || written != body_length) {
+        // Corpo truncado ou diferente do Content-Length já escrito: nada é enviado
+        printf("Erro ao montar a resposta HTTP (%d/%d bytes)\n", written, body_length);
+        return -1;
+    }
+    return header_length + written;
+}
+
+// Resposta para clientes acima do limite de requisições
+static const char too_many_requests[] =
+    "HTTP/1.1 429 Too Many Requests\r\n"
+    "Retry-After: 1\r\n"
+    "Content-Length: 0\r\n"
+    "Connection: close\r\n\r\n";
+
+// Resposta quando a página não pôde ser montada
+static const char internal_error[] =
+    "HTTP/1.1 500 Internal Server Error\r\n"
+    "Content-Length: 0\r\n"
+    "Connection: close\r\n\r\n";
+
+// Buffer do status em JSON (/api/status)
+static char status_json[768];
+
+// Encerra a conexão após o envio; retorna ERR_ABRT se o pcb precisou ser abortado
+static err_t close_connection(struct tcp_pcb *tpcb) {
+    tcp_output(tpcb);
+    tcp_recv(tpcb, NULL);
+    if (tcp_close(tpcb) != ERR_OK) {
+        tcp_abort(tpcb);
+        return ERR_ABRT;
+    }
+    return ERR_OK;
+}
+
+// Endereço IPv4 do cliente, chave do limitador de requisições
+static uint32_t client_ip(struct tcp_pcb *tpcb) {
+    return ip4_addr_get_u32(ip_2_ip4(&tpcb->remote_ip));
+}
+
+// Comandos que mudam estado têm fila própria no limitador
+static bool is_command_request(const char *request) {
+    return strstr(request, "GET /led") || strstr(request, "GET /buzzer/") || strstr(request, "POST /ota");
+}
 
-    int body_length = strlen(html_body);
+// Responde com o estado dos sensores e os contadores internos em JSON
+static err_t send_status_json(struct tcp_pcb *tpcb) {
+    notify_stats_t ns = notify_get_stats();
+    rate_limit_stats_t rs = rate_limit_get_stats();
+    ota_status_t os = ota_get_status();
+    int body_length = snprintf(status_json, sizeof(status_json),
+        "{\"sensor_a\":\"%s\",\"sensor_b_pressed\":%s,\"low_power\":%s,"
+        "\"pulses\":{\"a\":%lu,\"b\":%lu},"
+        "\"notify\":{\"sent_batches\":%lu,\"sent_events\":%lu,\"failed_attempts\":%lu,\"dropped_events\":%lu},"
+        "\"rate_limit\":{\"page\":{\"allowed\":%lu,\"limited\":%lu,\"burst\":%d,\"per_sec\":%d},"
+        "\"command\":{\"allowed\":%lu,\"limited\":%lu,\"burst\":%d,\"per_sec\":%d},"
+        "\"rejected_connections\":%lu,\"table_full\":%lu},"
+        "\"ota\":{\"state\":\"%s\",\"last_result\":\"%s\",\"received\":%lu,\"written\":%lu}}",
+        sensor1_message, sensor2_pressed ? "true" : "false", low_power_active ? "true" : "false",
+        (unsigned long)debounce_get_pulse_count(BUTTON1_PIN), (unsigned long)debounce_get_pulse_count(BUTTON2_PIN),
+        (unsigned long)ns.sent_batches, (unsigned long)ns.sent_events,
+        (unsigned long)ns.failed_attempts, (unsigned long)ns.dropped_events,
+        (unsigned long)rs.allowed[RATE_LANE_PAGE], (unsigned long)rs.limited[RATE_LANE_PAGE],
+        RATE_LIMIT_PAGE_BURST, RATE_LIMIT_PAGE_PER_SEC,
+        (unsigned long)rs.allowed[RATE_LANE_COMMAND], (unsigned long)rs.limited[RATE_LANE_COMMAND],
+        RATE_LIMIT_COMMAND_BURST, RATE_LIMIT_COMMAND_PER_SEC,
+        (unsigned long)rs.rejected_connections, (unsigned long)rs.table_full,
+        os.state, os.last_result, (unsigned long)os.received, (unsigned long)os.written);
+    if (body_length < 0 || body_length >= (int)sizeof(status_json)) {
+        printf("Erro ao montar o status JSON\n");
+        return close_connection(tpcb);
+    }
 
-    // Constrói o header HTTP com o Content-Length calculado e Connection: close
-    char header[256];
-    snprintf(header, sizeof(header),
+    char header[128];
+    int header_length = snprintf(header, sizeof(header),
         "HTTP/1.1 200 OK\r\n"
-        "Cache-Control: no-cache, no-store, must-revalidate\r\n"
-        "Pragma: no-cache\r\n"
-        "Expires: 0\r\n"
+        "Cache-Control: no-cache\r\n"
+        "Content-Type: application/json\r\n"
         "Content-Length: %d\r\n"
-        "Content-Type: text/html; charset=UTF-8\r\n"
         "Connection: close\r\n\r\n", body_length);
+    tcp_write(tpcb, header, header_length, TCP_WRITE_FLAG_COPY | TCP_WRITE_FLAG_MORE);
+    tcp_write(tpcb, status_json, body_length, TCP_WRITE_FLAG_COPY);
+    return close_connection(tpcb);
+}
 
-    // Concatena o header e o corpo para formar a resposta final
-    snprintf(http_response, sizeof(http_response), "%s%s", header, html_body);
+// Envia um bloco da saída RLE do framebuffer para a conexão
+static bool framebuffer_write(void *ctx, const uint8_t *data, size_t len) {
+    return tcp_write((struct tcp_pcb *)ctx, data, len, TCP_WRITE_FLAG_COPY | TCP_WRITE_FLAG_MORE) == ERR_OK;
+}
+
+// Responde com o framebuffer do OLED em RLE (corpo delimitado pelo fechamento da conexão)
+static err_t send_framebuffer(struct tcp_pcb *tpcb) {
+    static const char header[] =
+        "HTTP/1.1 200 OK\r\n"
+        "Cache-Control: no-cache, no-store, must-revalidate\r\n"
+        "Content-Type: application/octet-stream\r\n"
+        "Connection: close\r\n\r\n";
+    static const char busy[] =
+        "HTTP/1.1 503 Service Unavailable\r\n"
+        "Retry-After: 1\r\n"
+        "Content-Length: 0\r\n"
+        "Connection: close\r\n\r\n";
+
+    // Só começa se o pior caso couber no buffer de envio: nunca bloqueia o lwIP
+    if (tcp_sndbuf(tpcb) < sizeof(header) - 1 + SSD1306_RLE_MAX_SIZE(&ssd)) {
+        tcp_write(tpcb, busy, sizeof(busy) - 1, 0);
+    } else if (tcp_write(tpcb, header, sizeof(header) - 1, TCP_WRITE_FLAG_MORE) != ERR_OK ||
+               !ssd1306_rle_encode(&ssd, framebuffer_write, tpcb)) {
+        // Sem Content-Length, fechar normalmente entregaria um quadro truncado como 200 OK:
+        // o RST avisa o cliente que a resposta falhou
+        printf("Erro ao enviar o framebuffer\n");
+        tcp_abort(tpcb);
+        return ERR_ABRT;
+    }
+    return close_connection(tpcb);
 }
 
 // Callback para processar as requisições HTTP
@@ -116,6 +262,28 @@ static err_t http_callback(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_
         return ERR_OK;
     }
     char *request = (char *)p->payload;
+    // Toda requisição restaura o desempenho total (tratado no loop principal)
+    wake_requested = true;
+    __sev();
+    // Páginas e comandos consomem baldes separados: carga de páginas não bloqueia comandos
+    rate_lane_t lane = is_command_request(request) ? RATE_LANE_COMMAND : RATE_LANE_PAGE;
+    if (!rate_limit_request(client_ip(tpcb), lane)) {
+        pbuf_free(p);
+        tcp_write(tpcb, too_many_requests, sizeof(too_many_requests) - 1, 0);
+        return close_connection(tpcb);
+    }
+    if (strstr(request, "GET /framebuffer")) {
+        pbuf_free(p);
+        return send_framebuffer(tpcb);
+    }
+    if (strstr(request, "GET /api/status")) {
+        pbuf_free(p);
+        return send_status_json(tpcb);
+    }
+    if (strstr(request, "POST /ota")) {
+        // A conexão passa a ser tratada pelo OTA, que libera o pbuf
+        return ota_begin(tpcb, p);
+    }
     if (strstr(request, "GET /status")) {
         // Atualiza o sensor1_message, se necessário
         // Responde apenas com o status do sensor A
@@ -137,18 +305,33 @@ static err_t http_callback(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_
     else if (strstr(request, "GET /buzzer/on")) {
         buzzer_start(2000);  // Liga o buzzer com 2000 Hz
         sensor_alarm_triggered = false;
+        notify_event(NOTIFY_EVENT_BUZZER_ON);
     } else if (strstr(request, "GET /buzzer/off")) {
         buzzer_stop();
         sensor_alarm_triggered = false;
+        notify_event(NOTIFY_EVENT_BUZZER_OFF);
     }
-    create_http_response();
-    tcp_write(tpcb, http_response, strlen(http_response), TCP_WRITE_FLAG_COPY);
+    int response_length = create_http_response();
     pbuf_free(p);
+    if (response_length < 0) {
+        tcp_write(tpcb, internal_error, sizeof(internal_error) - 1, 0);
+        return close_connection(tpcb);
+    }
+    tcp_write(tpcb, http_response, response_length, TCP_WRITE_FLAG_COPY);
     return ERR_OK;
 }
 
 // Callback de conexão: associa o callback HTTP à nova conexão
 static err_t connection_callback(void *arg, struct tcp_pcb *newpcb, err_t err) {
+    // Sem memória para um novo pcb (comum sob rajada de conexões) o lwIP chama com NULL
+    if (err != ERR_OK || newpcb == NULL) {
+        return ERR_VAL;
+    }
+    // Cliente sem tokens em nenhuma fila: 429 antes de qualquer processamento
+    if (!rate_limit_accept(client_ip(newpcb))) {
+        tcp_write(newpcb, too_many_requests, sizeof(too_many_requests) - 1, 0);
+        return close_connection(newpcb);
+    }
     tcp_recv(newpcb, http_callback);
     return ERR_OK;
 }
@@ -172,6 +355,8 @@ static void start_http_server(void) {
 // Função para atualizar o display OLED com informações do sistema
 void update_display() {
     char buffer[32];
+    // Desenha com o lock do lwIP para /framebuffer nunca ver um quadro pela metade
+    cyw43_arch_lwip_begin();
     ssd1306_fill(&ssd, false);
 
     // Exibe o status do Wi-Fi e o IP, se conectado
@@ -189,10 +374,50 @@ void update_display() {
     // Exibe os estados dos sensores
     // ssd1306_draw_string(&ssd,sensor1_message,0, 30);
     // ssd1306_draw_string(&ssd, sensor2_message,0, 40);
+    cyw43_arch_lwip_end();
     ssd1306_send_data(&ssd);
 }
 
+// Troca o clock do sistema e reajusta os periféricos que dependem dele
+static void set_system_clock(uint32_t khz) {
+    set_sys_clock_khz(khz, true);
+    // I2C e PIO usam clk_sys; a UART passa a usar clk_peri (48 MHz, PLL USB)
+    i2c_set_baudrate(I2C_PORT, 400 * 1000);
+    debounce_update_clock();
+#ifdef uart_default
+    uart_set_baudrate(uart_default, PICO_DEFAULT_UART_BAUD_RATE);
+#endif
+    if (buzzer_frequency) {
+        buzzer_start(buzzer_frequency);
+    }
+}
+
+// Entra no modo armado/ocioso: Wi-Fi em power-save, display apagado e clock reduzido
+static void enter_low_power_mode() {
+    ssd1306_command(&ssd, SET_DISP | 0x00);
+    cyw43_arch_lwip_begin();
+    cyw43_wifi_pm(&cyw43_state, CYW43_AGGRESSIVE_PM);
+    set_system_clock(SYS_CLOCK_IDLE_KHZ);
+    cyw43_arch_lwip_end();
+    low_power_active = true;
+    printf("Modo de baixo consumo ativado\n");
+}
+
+// Restaura o desempenho total (clock primeiro, para o alarme não esperar o I2C)
+static void exit_low_power_mode() {
+    cyw43_arch_lwip_begin();
+    set_system_clock(SYS_CLOCK_FULL_KHZ);
+    cyw43_wifi_pm(&cyw43_state, CYW43_DEFAULT_PM);
+    cyw43_arch_lwip_end();
+    ssd1306_command(&ssd, SET_DISP | 0x01);
+    low_power_active = false;
+    printf("Modo de baixo consumo desativado\n");
+}
+
 int main() {
+    // Conclui uma troca de slots pendente (ou rollback) antes de qualquer outra coisa
+    ota_boot_check();
+
     stdio_init_all();
     sleep_ms(10000);
     printf("Iniciando servidor HTTP\n");
@@ -249,30 +474,50 @@ int main() {
     gpio_set_dir(BUTTON2_PIN, GPIO_IN);
     gpio_pull_up(BUTTON2_PIN);
 
-    // Configura as interrupções para os botões (rising e falling edge)
-    gpio_set_irq_enabled_with_callback(BUTTON1_PIN, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true, &gpio_callback);
-    gpio_set_irq_enabled(BUTTON2_PIN, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true);
+    // Debounce em hardware: a PIO gera uma interrupção por borda qualificada
+    if (!debounce_init(BUTTON1_PIN, DEBOUNCE_PERIOD_US, sensor_edge_callback) ||
+        !debounce_init(BUTTON2_PIN, DEBOUNCE_PERIOD_US, sensor_edge_callback)) {
+        printf("Erro ao configurar o debounce dos botões\n");
+        return 1;
+    }
 
     // Inicia o servidor HTTP
     start_http_server();
 
+    // Inicia o envio de notificações para o coletor local
+    notify_init();
+
+    // Wi-Fi e servidor no ar: uma imagem recém-atualizada é confirmada aqui
+    ota_confirm();
+
+    last_activity_ms = to_ms_since_boot(get_absolute_time());
+
     // Loop principal
     while (true) {
         cyw43_arch_poll();
 
+        // Sai do modo ocioso na primeira borda de sensor ou requisição HTTP
+        if (wake_requested) {
+            wake_requested = false;
+            last_activity_ms = to_ms_since_boot(get_absolute_time());
+            if (low_power_active) {
+                exit_low_power_mode();
+            }
+        }
+
         // Atualiza as mensagens dos sensores
         if (sensor_alarm_triggered) {
-            snprintf(sensor1_message, sizeof(sensor1_message), "Movimento detectado!");
+            snprintf(sensor1_message, sizeof(sensor1_message), SENSOR1_MSG_MOTION);
         } else {
-            snprintf(sensor1_message, sizeof(sensor1_message), "Nenhum movimento (Sensor A)");
+            snprintf(sensor1_message, sizeof(sensor1_message), SENSOR1_MSG_IDLE);
         }
         if (sensor2_pressed) {
-            snprintf(sensor2_message, sizeof(sensor2_message), "Entrando em BOOTSEL...");
+            snprintf(sensor2_message, sizeof(sensor2_message), SENSOR2_MSG_BOOTSEL);
             printf("Botão B pressionado: entrando em modo BOOTSEL\n");
             sleep_ms(100);  // Pausa para estabilização
             reset_usb_boot(0, 0);
         } else {
-            snprintf(sensor2_message, sizeof(sensor2_message), "Botão B: pressione para BOOTSEL");
+            snprintf(sensor2_message, sizeof(sensor2_message), SENSOR2_MSG_IDLE);
         }
         
         // Se o sensor A for acionado e o alarme não estiver ativo, ativa o buzzer
@@ -280,6 +525,7 @@ int main() {
             buzzer_start(2000);
             sensor_alarm_triggered = true;
             alarm_start_ms = to_ms_since_boot(get_absolute_time());
+            notify_event(NOTIFY_EVENT_MOTION);
         }
         // Desativa o alarme após 2 segundos
         if (sensor_alarm_triggered) {
@@ -291,6 +537,29 @@ int main() {
             }
         }
         
+        // Envia os eventos pendentes em lote (com backoff entre tentativas)
+        notify_poll();
+
+        // Grava na flash os dados de um upload OTA em andamento
+        ota_poll();
+
+        // Sem atividade por IDLE_TIMEOUT_MS: entra no modo ocioso (alarme continua armado)
+        if (!low_power_active && !sensor_alarm_triggered && buzzer_frequency == 0 && !ota_busy() &&
+            to_ms_since_boot(get_absolute_time()) - last_activity_ms >= IDLE_TIMEOUT_MS) {
+            enter_low_power_mode();
+        }
+
+        if (low_power_active) {
+            // Dorme até a próxima interrupção (GPIO, rede) ou o timeout
+            best_effort_wfe_or_timeout(make_timeout_time_ms(IDLE_WAKE_CHECK_MS));
+            continue;
+        }
+
+        // Durante o OTA o loop não dorme: cada volta grava mais um bloco na flash
+        if (ota_busy()) {
+            continue;
+        }
+
         // Atualiza o display OLED com as informações atuais
         update_display();
 